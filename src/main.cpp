@@ -10,6 +10,14 @@
 #include <codecvt>
 #include <locale>
 #include <iomanip>
+#include <sstream>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <cstdlib>
+#include <cctype>
+#include <limits>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
@@ -126,6 +134,354 @@ sf::String toSf(const std::string& utf8)
     return sf::String::fromUtf8(utf8.begin(), utf8.end());
 }
 
+// ASCII lower-case (the search matches file names case-insensitively)
+static std::string toLower(const std::string &s) {
+    std::string out;
+    for (unsigned char c : s) out += std::tolower(c);
+    return out;
+}
+
+// ----------------- Result cache -----------------
+// Repeated queries are answered from an LRU cache keyed by (root, query).
+// Every entry remembers each directory it walked together with that directory's
+// mtime, so a hit only re-stats those directories and re-lists the ones whose
+// contents changed (a directory's mtime moves when entries are added, removed or
+// renamed in it, but not when something changes deeper in the tree).
+
+struct CachedDir {
+    int64_t mtime = 0;
+    std::vector<std::string> files; // matching files directly inside this dir
+};
+
+struct CachedResult {
+    std::map<std::string, CachedDir> dirs;
+
+    size_t bytes() const {
+        size_t n = sizeof(CachedResult);
+        for (auto &d : dirs) {
+            n += d.first.size() + sizeof(CachedDir) + 64; // 64 ~ map node overhead
+            for (auto &f : d.second.files) n += f.size() + sizeof(std::string);
+        }
+        return n;
+    }
+
+    std::vector<std::string> flatten() const {
+        std::vector<std::string> out;
+        for (auto &d : dirs) out.insert(out.end(), d.second.files.begin(), d.second.files.end());
+        return out;
+    }
+};
+
+static bool dirMtime(const fs::path &dir, int64_t &out) {
+    std::error_code ec;
+    auto t = fs::last_write_time(dir, ec);
+    if (ec) return false;
+    out = static_cast<int64_t>(t.time_since_epoch().count());
+    return true;
+}
+
+// Never equals a real mtime, so a dir stored with it is re-listed on the next hit.
+static const int64_t kRelistMtime = std::numeric_limits<int64_t>::min();
+
+// Taken before a walk / re-listing starts. A directory whose mtime is at or after
+// this may be "racily clean": it could change again within the same timestamp tick
+// after we listed it without the mtime moving. The 2 s margin covers coarse
+// filesystems (HFS+ has 1 s, FAT/exFAT 2 s mtimes).
+static int64_t walkStartStamp() {
+    auto t = fs::file_time_type::clock::now() - std::chrono::seconds(2);
+    return static_cast<int64_t>(t.time_since_epoch().count());
+}
+
+// Read a dir's mtime for storing in an entry; racy ones are stored as kRelistMtime.
+static bool dirMtimeForCache(const fs::path &dir, int64_t walkStart, int64_t &out) {
+    if (!dirMtime(dir, out)) return false;
+    if (out >= walkStart) out = kRelistMtime;
+    return true;
+}
+
+class ResultCache {
+public:
+    explicit ResultCache(size_t budgetBytes) : budget(budgetBytes) {}
+
+    void setBudget(size_t budgetBytes) {
+        std::lock_guard<std::mutex> lg(m);
+        budget = budgetBytes;
+        evict();
+    }
+
+    bool enabled() {
+        std::lock_guard<std::mutex> lg(m);
+        return budget > 0;
+    }
+
+    // Copies the entry out and marks it most recently used.
+    bool lookup(const std::string &key, CachedResult &out) {
+        std::lock_guard<std::mutex> lg(m);
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        lru.splice(lru.begin(), lru, it->second);
+        out = it->second->value;
+        return true;
+    }
+
+    void store(const std::string &key, CachedResult value) {
+        std::lock_guard<std::mutex> lg(m);
+        size_t bytes = value.bytes() + key.size();
+        eraseLocked(key);
+        if (bytes > budget) return; // would evict everything else and still not fit
+        lru.push_front({key, std::move(value), bytes});
+        index[key] = lru.begin();
+        used += bytes;
+        evict();
+    }
+
+    // Written to a temp file and renamed over the old one, so a crash mid-save
+    // never leaves a half-written cache behind.
+    void save(const fs::path &file) {
+        std::lock_guard<std::mutex> lg(m);
+        fs::path tmp = file;
+        tmp += ".tmp";
+        {
+            std::ofstream f(tmp.string(), std::ios::binary | std::ios::trunc);
+            if (!f) return;
+            f << "FSCACHE 1\n" << lru.size() << "\n";
+            // least recently used first, so load() restores the same order
+            for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
+                writeString(f, it->key);
+                f << it->value.dirs.size() << "\n";
+                for (auto &d : it->value.dirs) {
+                    writeString(f, d.first);
+                    f << d.second.mtime << " " << d.second.files.size() << "\n";
+                    for (auto &file : d.second.files) writeString(f, file);
+                }
+            }
+            f.flush();
+            if (!f) {
+                f.close();
+                std::error_code ec;
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmp, file, ec);
+        if (ec) fs::remove(tmp, ec);
+    }
+
+    // All or nothing: a truncated or corrupt file is ignored and the cache starts empty.
+    void load(const fs::path &file) {
+        std::vector<std::pair<std::string, CachedResult>> loaded;
+        try {
+            std::ifstream f(file.string(), std::ios::binary);
+            if (!f) return;
+            std::error_code ec;
+            const uintmax_t size = fs::file_size(file, ec);
+            if (ec) return;
+            std::string magic;
+            int version = 0;
+            size_t entries = 0;
+            if (!(f >> magic >> version >> entries) || magic != "FSCACHE" || version != 1) return;
+            // every entry / dir / file takes at least a couple of bytes on disk
+            if (entries > size) return;
+            for (size_t e = 0; e < entries; ++e) {
+                std::string key;
+                size_t dirCount = 0;
+                if (!readString(f, key, size) || !(f >> dirCount) || dirCount > size) return;
+                CachedResult value;
+                for (size_t i = 0; i < dirCount; ++i) {
+                    std::string dir;
+                    CachedDir cd;
+                    size_t fileCount = 0;
+                    if (!readString(f, dir, size) || !(f >> cd.mtime >> fileCount) || fileCount > size) return;
+                    for (size_t j = 0; j < fileCount; ++j) {
+                        std::string path;
+                        if (!readString(f, path, size)) return;
+                        cd.files.push_back(std::move(path));
+                    }
+                    value.dirs.emplace(std::move(dir), std::move(cd));
+                }
+                loaded.emplace_back(std::move(key), std::move(value));
+            }
+        } catch (...) {
+            return;
+        }
+        for (auto &kv : loaded) store(kv.first, std::move(kv.second));
+    }
+
+    void erase(const std::string &key) {
+        std::lock_guard<std::mutex> lg(m);
+        eraseLocked(key);
+    }
+
+private:
+    struct Node {
+        std::string key;
+        CachedResult value;
+        size_t bytes;
+    };
+
+    // caller holds m
+    void eraseLocked(const std::string &key) {
+        auto it = index.find(key);
+        if (it == index.end()) return;
+        used -= it->second->bytes;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    // caller holds m
+    void evict() {
+        while (used > budget && !lru.empty()) {
+            used -= lru.back().bytes;
+            index.erase(lru.back().key);
+            lru.pop_back();
+        }
+    }
+
+    // length-prefixed so paths with spaces / newlines round-trip
+    static void writeString(std::ostream &f, const std::string &s) {
+        f << s.size() << " " << s << "\n";
+    }
+
+    // `fileSize` bounds the length prefix so a corrupt file can't ask for a huge buffer
+    static bool readString(std::istream &f, std::string &s, uintmax_t fileSize) {
+        size_t len = 0;
+        if (!(f >> len) || f.get() != ' ') return false;
+        std::streamoff pos = f.tellg();
+        if (pos < 0 || len > fileSize - static_cast<uintmax_t>(pos)) return false;
+        s.resize(len);
+        return static_cast<bool>(f.read(&s[0], len));
+    }
+
+    std::mutex m;
+    std::list<Node> lru;
+    std::unordered_map<std::string, std::list<Node>::iterator> index;
+    size_t used = 0;
+    size_t budget;
+};
+
+ResultCache resultCache(64u << 20);
+
+static fs::path resultCacheFile() {
+    return fs::path(homeDir) / "Desktop" / "FileSearchApp" / "log" / "result_cache.dat";
+}
+
+// One spelling per directory ("Desktop", "Desktop/" and a symlink to it all map to
+// the same path), so the walk, the cache key and the per-dir buckets agree.
+static fs::path normalizeRoot(const fs::path &startDir) {
+    std::error_code ec;
+    fs::path root = fs::weakly_canonical(startDir, ec);
+    if (ec) root = startDir.lexically_normal();
+    std::string r = root.string();
+    while (r.size() > 1 && r.back() == '/') r.pop_back();
+    return fs::path(r);
+}
+
+// `root` must already be normalizeRoot()-ed. searchEverywhere isn't part of the
+// key: it only picks the root and drives the uncached "Found elsewhere" fallback.
+static std::string cacheKey(const fs::path &root, const std::string &lowerQuery) {
+    return root.string() + '\0' + lowerQuery;
+}
+
+static bool matchesQuery(const fs::path &file, const std::string &lowerQuery) {
+    return toLower(file.filename().string()).find(lowerQuery) != std::string::npos;
+}
+
+// The one definition of which directories an entry covers: `root` plus every real
+// (non-symlink) directory below it. Their mtimes go into `entry` (when given) and
+// every regular file is appended to `files`. Returns false if the walk was
+// cancelled or cut short by an I/O error.
+static bool collectTree(const fs::path &root, CachedResult *entry, int64_t walkStart, std::vector<fs::path> &files) {
+    if (entry && !dirMtimeForCache(root, walkStart, entry->dirs[root.string()].mtime)) return false;
+    std::error_code ec;
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        if (cancelRequested.load()) return false;
+        const auto &e = *it;
+        std::error_code sec;
+        if (e.is_directory(sec) && !e.is_symlink(sec)) {
+            if (entry) dirMtimeForCache(e.path(), walkStart, entry->dirs[e.path().string()].mtime);
+        } else if (e.is_regular_file(sec)) {
+            files.push_back(e.path());
+        }
+    }
+    return !ec;
+}
+
+// Walk `root` into `entry`, filing each match under its directory.
+static bool walkIntoCache(const fs::path &root, const std::string &lowerQuery, int64_t walkStart, CachedResult &entry) {
+    std::vector<fs::path> files;
+    if (!collectTree(root, &entry, walkStart, files)) return false;
+    for (auto &f : files)
+        if (matchesQuery(f, lowerQuery))
+            entry.dirs[f.parent_path().string()].files.push_back(f.string());
+    return true;
+}
+
+// Re-list one directory whose mtime changed; brand-new subdirectories are walked in full.
+// Returns false if cancelled or the directory couldn't be read to the end.
+static bool rescanDir(const std::string &dir, int64_t mtime, const std::string &lowerQuery, int64_t walkStart,
+                      CachedResult &entry) {
+    std::vector<std::string> files;
+    std::vector<fs::path> newDirs;
+    std::error_code ec;
+    fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        const auto &e = *it;
+        std::error_code sec;
+        if (e.is_directory(sec) && !e.is_symlink(sec)) {
+            if (!entry.dirs.count(e.path().string())) newDirs.push_back(e.path());
+        } else if (e.is_regular_file(sec)) {
+            if (matchesQuery(e.path(), lowerQuery)) files.push_back(e.path().string());
+        }
+    }
+    if (ec) return false;
+    CachedDir &cd = entry.dirs[dir];
+    cd.mtime = mtime >= walkStart ? kRelistMtime : mtime;
+    cd.files = std::move(files);
+    for (auto &d : newDirs)
+        if (!walkIntoCache(d, lowerQuery, walkStart, entry)) return false;
+    return true;
+}
+
+// Bring a cached entry for `root` up to date. Returns the number of directories
+// re-listed, or -1 if the root itself is gone, the search was cancelled or a
+// re-listing failed half-way (entry must not be reused then; the caller drops it
+// and does a full walk instead).
+static int revalidate(CachedResult &entry, const fs::path &root, const std::string &lowerQuery) {
+    const std::string rootKey = root.string();
+    const int64_t walkStart = walkStartStamp();
+    std::vector<std::pair<std::string, int64_t>> changed;
+    for (auto it = entry.dirs.begin(); it != entry.dirs.end();) {
+        if (cancelRequested.load()) return -1;
+        // one stat per unchanged dir; the type is only checked once the mtime moved
+        // (a dir replaced by a file has a different mtime)
+        int64_t now = 0;
+        if (!dirMtime(it->first, now)) {
+            if (it->first == rootKey) return -1;
+            it = entry.dirs.erase(it); // removed
+            continue;
+        }
+        if (now != it->second.mtime) {
+            std::error_code ec;
+            if (!fs::is_directory(fs::status(it->first, ec))) {
+                if (it->first == rootKey) return -1;
+                it = entry.dirs.erase(it); // replaced by a file
+                continue;
+            }
+            changed.emplace_back(it->first, now);
+        }
+        ++it;
+    }
+    // an entry that never recorded its root has nothing to validate against
+    if (!entry.dirs.count(rootKey)) return -1;
+    for (auto &c : changed) {
+        if (cancelRequested.load()) return -1;
+        if (!rescanDir(c.first, c.second, lowerQuery, walkStart, entry)) return -1;
+    }
+    return static_cast<int>(changed.size());
+}
+
 // ----------------- Search function -----------------
 void searchFiles(const fs::path& dir, const std::string& filenamePart, bool searchEverywhere) {
     std::ofstream log = openLogFile();
@@ -141,67 +497,89 @@ void searchFiles(const fs::path& dir, const std::string& filenamePart, bool sear
         std::vector<std::string> found;
         fs::path startDir = dir;
         if (searchEverywhere) startDir = fs::path(homeDir);
-
-        // Collect files first
-        std::vector<fs::path> allFiles;
-        std::error_code ec;
-        for (auto &entry : fs::recursive_directory_iterator(startDir, fs::directory_options::skip_permission_denied, ec)) {
-            if (!entry.is_regular_file()) continue;
-            allFiles.push_back(entry.path());
+        startDir = normalizeRoot(startDir);
+
+        const std::string lowerQuery = toLower(filenamePart);
+        const std::string key = cacheKey(startDir, lowerQuery);
+        const bool useCache = resultCache.enabled();
+        bool cacheHit = false;
+
+        CachedResult cached;
+        if (useCache && resultCache.lookup(key, cached)) {
+            int relisted = revalidate(cached, startDir, lowerQuery);
+            if (relisted >= 0) {
+                cacheHit = true;
+                found = cached.flatten();
+                log << "Cache: hit, re-listed " << relisted << " of " << cached.dirs.size() << " dirs\n";
+                resultCache.store(key, std::move(cached));
+            } else {
+                resultCache.erase(key); // stale; the full walk below re-stores it if it completes
+            }
         }
 
-        // Parallel processing
-        std::vector<std::thread> workers;
-        std::mutex foundMutex;
-
-        auto workerFunc = [&](int start, int end) {
-            for (int i = start; i < end; ++i) {
-                if (cancelRequested.load()) return;
-
-                auto toLower = [](const std::string &s) {
-                    std::string out;
-                    for (unsigned char c : s) out += std::tolower(c);
-                    return out;
-                };
-
-                const auto &path = allFiles[i];
-                std::string name = path.filename().string();
-
-                // сравнение без учёта регистра
-                if (toLower(name).find(toLower(filenamePart)) != std::string::npos) {
-                    {
-                        std::lock_guard<std::mutex> g(foundMutex);
-                        found.push_back(path.string());
-                    }
+        if (!cacheHit) {
+            // Collect files first (and the dirs we pass through, for the cache)
+            std::vector<fs::path> allFiles;
+            CachedResult fresh;
+            // set by whoever bails on cancel or error; the global flag may already be reset by the
+            // next search when we get to store(), so it can't be trusted at that point
+            std::atomic<bool> aborted(false);
+            if (!collectTree(startDir, useCache ? &fresh : nullptr, walkStartStamp(), allFiles)) aborted = true;
+
+            // Parallel processing
+            std::vector<std::thread> workers;
+            std::mutex foundMutex;
+
+            auto workerFunc = [&](int start, int end) {
+                for (int i = start; i < end; ++i) {
+                    if (cancelRequested.load()) { aborted = true; return; }
+
+                    const auto &path = allFiles[i];
+
+                    // сравнение без учёта регистра
+                    if (matchesQuery(path, lowerQuery)) {
+                        {
+                            std::lock_guard<std::mutex> g(foundMutex);
+                            found.push_back(path.string());
+                        }
 
-                    // Log this thread’s work
-                    {
-                    static std::mutex tlogMutex;
-                    std::lock_guard<std::mutex> lg(tlogMutex);
-                    auto tlog = openThreadLog();
-                    tlog << timestampNow()
-                        << " | thread=" << std::this_thread::get_id()
-                        << " processed: " << path.string()
-                        << "\n";
+                        // Log this thread’s work
+                        {
+                        static std::mutex tlogMutex;
+                        std::lock_guard<std::mutex> lg(tlogMutex);
+                        auto tlog = openThreadLog();
+                        tlog << timestampNow()
+                            << " | thread=" << std::this_thread::get_id()
+                            << " processed: " << path.string()
+                            << "\n";
+                        }
                     }
                 }
+            };
+
+            // Split work
+            int total = allFiles.size();
+            int chunk = std::max(1, total / threadCount.load());
+            int start = 0;
+
+            for (int i = 0; i < threadCount; ++i) {
+                int end = std::min(start + chunk, total);
+                workers.emplace_back(workerFunc, start, end);
+                start = end;
             }
-        };
 
-        // Split work
-        int total = allFiles.size();
-        int chunk = std::max(1, total / threadCount.load());
-        int start = 0;
+            // join workers
+            for (auto &t : workers) t.join();
 
-        for (int i = 0; i < threadCount; ++i) {
-            int end = std::min(start + chunk, total);
-            workers.emplace_back(workerFunc, start, end);
-            start = end;
+            // a cancelled or cut-short search saw only part of the tree, don't remember it
+            if (useCache && !aborted.load()) {
+                for (auto &f : found)
+                    fresh.dirs[fs::path(f).parent_path().string()].files.push_back(f);
+                log << "Cache: stored " << fresh.dirs.size() << " dirs\n";
+                resultCache.store(key, std::move(fresh));
+            }
         }
 
-        // join workers
-        for (auto &t : workers) t.join();
-
         {
             std::lock_guard<std::mutex> lg(resultMutex);
             // Вставляем количество найденных файлов в начало
@@ -294,6 +672,23 @@ int main() {
         fs::create_directories(fs::path(homeDir) / "Desktop" / "FileSearchApp" / "log");
     } catch (...) {}
 
+    // result cache: FILESEARCH_CACHE_MB sets the memory budget (0 turns it off),
+    // FILESEARCH_CACHE_PERSIST=0 keeps it in memory only
+    if (const char* mb = getenv("FILESEARCH_CACHE_MB")) {
+        std::string v(mb);
+        if (!v.empty() && std::all_of(v.begin(), v.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            // strtoull saturates at ULLONG_MAX on overflow; clamp so "<< 20" can't wrap
+            const unsigned long long maxMb = std::numeric_limits<size_t>::max() >> 20;
+            unsigned long long n = std::min(std::strtoull(v.c_str(), nullptr, 10), maxMb);
+            resultCache.setBudget(static_cast<size_t>(n) << 20);
+        } else {
+            std::cerr << "Ignoring FILESEARCH_CACHE_MB=" << v << " (expected a number of megabytes)" << std::endl;
+        }
+    }
+    const char* persistEnv = getenv("FILESEARCH_CACHE_PERSIST");
+    bool persistCache = !(persistEnv && std::string(persistEnv) == "0");
+    if (persistCache && resultCache.enabled()) resultCache.load(resultCacheFile());
+
     // Create fullscreen window 
     sf::RenderWindow window(sf::VideoMode::getDesktopMode(), "File Search App", sf::Style::Default, sf::State::Fullscreen);
     window.setFramerateLimit(60);
@@ -668,6 +1063,7 @@ int main() {
     // cleanup
     cancelRequested = true;
     if (searchThread.joinable()) searchThread.join();
+    if (persistCache && resultCache.enabled()) resultCache.save(resultCacheFile());
 
     return 0;
 }